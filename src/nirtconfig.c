@@ -2,6 +2,15 @@
 #include <cstring>
 #include <string>
 #include <unistd.h>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <dirent.h>
+#include <ftw.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
 #include <nisyscfg/nisyscfg.h>
 #include "nirtconfig.h"
 
@@ -23,13 +32,19 @@ static const struct
     { "listhw", nirtconfig_listHardware },
     { "format", nirtconfig_format },
     { "setalias", nirtconfig_setAlias },
+    { "schedule", nirtconfig_scheduleTransfers },
     { NULL, NULL }
 };
 
+static int showHandleStats = 0;
+static int failOnHandleLeak = 0;
+
 int main(int argc, char** argv)
 {
     int status = 0;
 
+    argc = nirtconfig_getGlobalOptions(argc, argv);
+
     if (argc > 1) //Command passed as argument
     {
         int i = 0;
@@ -54,12 +69,37 @@ int main(int argc, char** argv)
         status = 1;
     }
 
+    if (showHandleStats)
+        nirtconfig_printHandleStats();
+
+    if (failOnHandleLeak && nirtconfig_printLeakedHandles() > 0 && status == 0)
+        status = 1; //Leaked handles fail the run
+
     if (status != 0)
         nirtconfig_printStatusInfo(status);
 
     return status;
 }
 
+int nirtconfig_getGlobalOptions(int argc, char** argv)
+{
+    int count = 1;
+
+    for (int i = 1; i < argc; i++) //Strip global flags so commands see only their own arguments
+    {
+        if (strcmp(argv[i], "--stats") == 0)
+            showHandleStats = 1;
+        else if (strcmp(argv[i], "--fail-on-leak") == 0)
+            failOnHandleLeak = 1;
+        else
+            argv[count++] = argv[i];
+    }
+
+    argv[count] = NULL;
+
+    return count;
+}
+
 void nirtconfig_printStatusInfo(int status)
 {
     char* detailedResults = NULL;
@@ -73,6 +113,168 @@ void nirtconfig_printStatusInfo(int status)
     NISysCfgFreeDetailedString(detailedResults);
 }
 
+static const char* const handleKindNames[NIRTCONFIG_HANDLE_KINDS] = { "Session", "Resource", "Filter", "Enumeration" };
+static struct handleRecord* liveHandles = NULL;
+static struct handleStats handleStats[NIRTCONFIG_HANDLE_KINDS] = {};
+static int liveHandleTotal = 0;
+static int peakHandleTotal = 0;
+static pthread_mutex_t handleLock = PTHREAD_MUTEX_INITIALIZER;
+
+void nirtconfig_trackHandle(void* handle, enum handleKind kind)
+{
+    if (handle == NULL)
+        return;
+
+    struct handleRecord* record = (struct handleRecord*)malloc(sizeof(struct handleRecord));
+    record->handle = handle;
+    record->kind = kind;
+
+    pthread_mutex_lock(&handleLock);
+
+    record->next = liveHandles;
+    liveHandles = record;
+
+    handleStats[kind].opened++;
+    if (++handleStats[kind].live > handleStats[kind].peak)
+        handleStats[kind].peak = handleStats[kind].live;
+    if (++liveHandleTotal > peakHandleTotal)
+        peakHandleTotal = liveHandleTotal;
+
+    pthread_mutex_unlock(&handleLock);
+}
+
+NISysCfgStatus nirtconfig_closeHandle(void* handle)
+{
+    if (handle == NULL)
+        return NISysCfg_OK; //Nothing was opened
+
+    pthread_mutex_lock(&handleLock);
+
+    for (struct handleRecord** record = &liveHandles; *record != NULL; record = &(*record)->next)
+    {
+        if ((*record)->handle == handle)
+        {
+            struct handleRecord* closed = *record;
+
+            handleStats[closed->kind].closed++;
+            handleStats[closed->kind].live--;
+            liveHandleTotal--;
+
+            *record = closed->next;
+            free(closed);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&handleLock);
+
+    return NISysCfgCloseHandle(handle);
+}
+
+NISysCfgStatus nirtconfig_initializeSession(const char* targetName, const char* username, const char* password,
+                                            NISysCfgLocale language, NISysCfgBool forcePropertyRefresh, unsigned int connectTimeoutMsec,
+                                            NISysCfgEnumExpertHandle* expertEnumHandle, NISysCfgSessionHandle* sessionHandle)
+{
+    NISysCfgStatus status = NISysCfgInitializeSession(targetName, username, password, language, forcePropertyRefresh,
+                                                      connectTimeoutMsec, expertEnumHandle, sessionHandle);
+
+    if (status == NISysCfg_OK)
+    {
+        nirtconfig_trackHandle(*sessionHandle, HANDLE_SESSION);
+        if (expertEnumHandle != NULL)
+            nirtconfig_trackHandle(*expertEnumHandle, HANDLE_ENUMERATION);
+    }
+
+    return status;
+}
+
+NISysCfgStatus nirtconfig_findSystems(NISysCfgSessionHandle session, const char* deviceClass, NISysCfgBool detectOnlineSystems,
+                                      NISysCfgIncludeCachedResults cachePreference, NISysCfgSystemNameFormat systemNameFormat,
+                                      int timeoutMsec, NISysCfgBool onlyInstallableSystems, NISysCfgEnumSystemHandle* systemEnumHandle)
+{
+    NISysCfgStatus status = NISysCfgFindSystems(session, deviceClass, detectOnlineSystems, cachePreference,
+                                                systemNameFormat, timeoutMsec, onlyInstallableSystems, systemEnumHandle);
+
+    if (status == NISysCfg_OK)
+        nirtconfig_trackHandle(*systemEnumHandle, HANDLE_ENUMERATION);
+
+    return status;
+}
+
+NISysCfgStatus nirtconfig_createFilter(NISysCfgSessionHandle session, NISysCfgFilterHandle* filter)
+{
+    NISysCfgStatus status = NISysCfgCreateFilter(session, filter);
+
+    if (status == NISysCfg_OK)
+        nirtconfig_trackHandle(*filter, HANDLE_FILTER);
+
+    return status;
+}
+
+NISysCfgStatus nirtconfig_findHardware(NISysCfgSessionHandle session, NISysCfgFilterMode filterMode, NISysCfgFilterHandle filter,
+                                       const char* expertNames, NISysCfgEnumResourceHandle* resourceEnumHandle)
+{
+    NISysCfgStatus status = NISysCfgFindHardware(session, filterMode, filter, expertNames, resourceEnumHandle);
+
+    if (status == NISysCfg_OK)
+        nirtconfig_trackHandle(*resourceEnumHandle, HANDLE_ENUMERATION);
+
+    return status;
+}
+
+NISysCfgStatus nirtconfig_nextResource(NISysCfgSessionHandle session, NISysCfgEnumResourceHandle resourceEnumHandle,
+                                       NISysCfgResourceHandle* resource)
+{
+    NISysCfgStatus status = NISysCfgNextResource(session, resourceEnumHandle, resource);
+
+    if (status == NISysCfg_OK)
+        nirtconfig_trackHandle(*resource, HANDLE_RESOURCE);
+
+    return status;
+}
+
+NISysCfgStatus nirtconfig_renameResource(NISysCfgResourceHandle resource, const char* newName, NISysCfgBool overwriteIfExists,
+                                         NISysCfgBool updateDependencies, NISysCfgBool* nameAlreadyExisted,
+                                         NISysCfgResourceHandle* overwrittenResource)
+{
+    NISysCfgStatus status = NISysCfgRenameResource(resource, newName, overwriteIfExists, updateDependencies,
+                                                   nameAlreadyExisted, overwrittenResource);
+
+    if (status == NISysCfg_OK)
+        nirtconfig_trackHandle(*overwrittenResource, HANDLE_RESOURCE); //Caller owns the displaced resource
+
+    return status;
+}
+
+void nirtconfig_printHandleStats()
+{
+    pthread_mutex_lock(&handleLock);
+
+    fprintf(stderr, "%-15s%-10s%-10s%-10s%s\n", "HANDLE TYPE", "OPENED", "CLOSED", "LIVE", "PEAK");
+    for (int i = 0; i < NIRTCONFIG_HANDLE_KINDS; i++)
+    {
+        fprintf(stderr, "%-15s%-10d%-10d%-10d%d\n", handleKindNames[i], handleStats[i].opened, handleStats[i].closed,
+                handleStats[i].live, handleStats[i].peak);
+    }
+    fprintf(stderr, "%-15s%-10s%-10s%-10d%d\n", "Total", "", "", liveHandleTotal, peakHandleTotal);
+
+    pthread_mutex_unlock(&handleLock);
+}
+
+int nirtconfig_printLeakedHandles()
+{
+    pthread_mutex_lock(&handleLock);
+
+    for (struct handleRecord* record = liveHandles; record != NULL; record = record->next)
+        fprintf(stderr, "Leaked %s Handle: %p\n", handleKindNames[record->kind], record->handle);
+
+    int leaked = liveHandleTotal;
+
+    pthread_mutex_unlock(&handleLock);
+
+    return leaked;
+}
+
 int nirtconfig_find(int argc, char** argv)
 {
     int status = 0;
@@ -95,8 +297,8 @@ int nirtconfig_findSingleTarget(char* targetName)
     int status = 0;
     NISysCfgSessionHandle session = NULL;
 
-    status = NISysCfgInitializeSession(targetName, NULL, NULL, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    status = nirtconfig_initializeSession(targetName, NULL, NULL, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializeing session
@@ -104,7 +306,7 @@ int nirtconfig_findSingleTarget(char* targetName)
     printf("%-35s%-20s%-15s%s\n", "HOSTNAME", "IP ADDR", "MODEL", "SERIAL NUMBER");
     nirtconfig_printSystemInfo(session);
 
-    status = NISysCfgCloseHandle(session);
+    status = nirtconfig_closeHandle(session);
 
     return status;
 }
@@ -118,22 +320,23 @@ int nirtconfig_findAllTargets()
 
     printf("Finding Available Targets...\n");
 
-    status = NISysCfgFindSystems(NULL, NULL, NISysCfgBoolTrue,
-                                 NISysCfgIncludeCachedResultsOnlyIfOnline, NISysCfgSystemNameFormatHostname,
-                                 10000, NISysCfgBoolTrue, &enumSystemHandle);
+    status = nirtconfig_findSystems(NULL, NULL, NISysCfgBoolTrue,
+                                    NISysCfgIncludeCachedResultsOnlyIfOnline, NISysCfgSystemNameFormatHostname,
+                                    10000, NISysCfgBoolTrue, &enumSystemHandle);
 
     printf("%-35s%-20s%-15s%s\n", "HOSTNAME", "IP ADDR", "MODEL", "SERIAL NUMBER");
 
     while (NISysCfgNextSystemInfo(enumSystemHandle, systemName) == NISysCfg_OK) //Iterate through systems found
     {
-        NISysCfgInitializeSession(systemName, NULL, NULL, NISysCfgLocaleDefault,
-                                  NISysCfgBoolFalse, 10000, NULL, &session);
+        session = NULL; //Don't reuse the previous system's closed handle if this one fails to connect
+        nirtconfig_initializeSession(systemName, NULL, NULL, NISysCfgLocaleDefault,
+                                     NISysCfgBoolFalse, 10000, NULL, &session);
 
         nirtconfig_printSystemInfo(session);
-        NISysCfgCloseHandle(session);
+        nirtconfig_closeHandle(session);
     }
 
-    NISysCfgCloseHandle(enumSystemHandle);
+    nirtconfig_closeHandle(enumSystemHandle);
 
     return status;
 }
@@ -155,69 +358,158 @@ void nirtconfig_printSystemInfo(NISysCfgSessionHandle session)
 
 int nirtconfig_getImage(int argc, char** argv)
 {
-    if (argc != 3) //Check for correct number of arguments
+    if (argc != 3 && !(argc == 5 && strcmp(argv[3], "--archive") == 0)) //Check for correct number of arguments
     {
-        printf("Error Expecting Arguments: getimage <TARGETNAME>\n");
+        printf("Error Expecting Arguments: getimage <TARGETNAME> [--archive <ARCHIVE_PATH|->]\n");
         return 0;
     }
 
+    char destination[PATH_MAX] = "";
+
+    return nirtconfig_getTargetImage(argv[2], NULL, NULL, destination, sizeof(destination), argc == 5 ? argv[4] : NULL);
+}
+
+int nirtconfig_getTargetImage(char* targetName, char* username, char* password, char* destination, size_t destinationSize, char* archivePath)
+{
     int status = 0;
     NISysCfgSessionHandle session = NULL;
+    char stagingDir[PATH_MAX] = "";
+    FILE* log = stdout;
+
+    if (archivePath != NULL && strcmp(archivePath, "-") == 0)
+        log = stderr; //Keep stdout clean for the archive stream
 
-    status = NISysCfgInitializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    status = nirtconfig_initializeSession(targetName, username, password, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializeing session
 
-    char destination[256] = "";
-    nirtconfig_buildOutputDir(session, destination);
+    if (archivePath != NULL && nirtconfig_createStagingDir(stagingDir, sizeof(stagingDir)) != 0)
+    {
+        fprintf(log, "Unable To Create Staging Folder\n");
+        nirtconfig_closeHandle(session);
+        return 1;
+    }
 
-    printf("Getting Image: %s\nSaving To: \"%s\"\n", argv[2], destination);
+    nirtconfig_buildOutputDir(session, archivePath != NULL ? stagingDir : NULL, destination, destinationSize);
+
+    fprintf(log, "Getting Image: %s\nSaving To: \"%s\"\n", targetName, archivePath != NULL ? archivePath : destination);
 
     status = NISysCfgGetSystemImageAsFolder2(session, NISysCfgBoolTrue, destination,
                                              NULL, 0, NULL, NISysCfgBoolTrue, NISysCfgBoolFalse);
 
+    nirtconfig_closeHandle(session);
+
+    if (archivePath != NULL) //Pack captured folder and discard the staging copy
+    {
+        if (status == 0)
+            status = nirtconfig_packImageArchive(destination, archivePath);
+
+        nirtconfig_removeStagingDir(stagingDir);
+    }
+
     return status;
 }
 
-void nirtconfig_buildOutputDir(NISysCfgSessionHandle session, char* pathBuffer)
+void nirtconfig_buildOutputDir(NISysCfgSessionHandle session, const char* parentDir, char* pathBuffer, size_t bufferSize)
 {
     char hostname[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
+    char directory[PATH_MAX] = "";
 
-    getcwd(pathBuffer, 256);
-    strcat(pathBuffer, "/");
+    if (parentDir != NULL)
+        snprintf(directory, sizeof(directory), "%s", parentDir);
+    else
+        getcwd(directory, sizeof(directory));
 
     NISysCfgGetSystemProperty(session, NISysCfgSystemPropertyHostname, hostname);
-    strcat(pathBuffer, hostname);
+    snprintf(pathBuffer, bufferSize, "%s/%s", directory, hostname);
 }
 
 int nirtconfig_setImage(int argc, char** argv)
 {
     if (argc != 4) //Check for correct number of arguments
     {
-        printf("Error Expecting Arguments: setimage <TARGETNAME> <IMAGEPATH>\n");
+        printf("Error Expecting Arguments: setimage <TARGETNAME> <IMAGEPATH|ARCHIVE_PATH|->\n");
         return 0;
     }
 
+    return nirtconfig_setTargetImage(argv[2], NULL, NULL, argv[3]);
+}
+
+int nirtconfig_setTargetImage(char* targetName, char* username, char* password, char* imagePath)
+{
     int status = 0;
     NISysCfgSessionHandle session = NULL;
+    char stagingDir[PATH_MAX] = "";
+    char imageFolder[PATH_MAX] = "";
 
-    status = NISysCfgInitializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    if (nirtconfig_isImageArchive(imagePath)) //Unpack archive into a staging folder first
+    {
+        if (nirtconfig_createStagingDir(stagingDir, sizeof(stagingDir)) != 0)
+        {
+            printf("Unable To Create Staging Folder\n");
+            return 1;
+        }
 
-    if (status != 0)
-        return status; //Error initializeing session
+        status = nirtconfig_unpackImageArchive(imagePath, stagingDir, imageFolder, sizeof(imageFolder));
+    }
+    else
+        snprintf(imageFolder, sizeof(imageFolder), "%s", imagePath);
+
+    if (status == 0)
+        status = nirtconfig_initializeSession(targetName, username, password, NISysCfgLocaleDefault,
+                                              NISysCfgBoolFalse, 10000, NULL, &session);
+
+    if (status == 0)
+    {
+        printf("Imaging Target: %s\nImage Used: %s\n", targetName, imagePath);
 
-    printf("Imaging Target: %s\nImage Used: %s\n", argv[2], argv[3]);
+        status = NISysCfgSetSystemImageFromFolder2(session, NISysCfgBoolTrue, imageFolder, "", 0, NULL,
+                                                   NISysCfgBoolFalse, NISysCfgPreservePrimaryResetOthers);
 
-    status = NISysCfgSetSystemImageFromFolder2(session, NISysCfgBoolTrue, argv[3], "", 0, NULL,
-                                               NISysCfgBoolFalse, NISysCfgPreservePrimaryResetOthers);
+        nirtconfig_closeHandle(session);
+    }
+
+    if (strlen(stagingDir))
+        nirtconfig_removeStagingDir(stagingDir);
 
-    NISysCfgCloseHandle(session);
     return status;
 }
 
+int nirtconfig_isImageArchive(const char* path)
+{
+    size_t length = strlen(path);
+    size_t extension = strlen(NIRTCONFIG_ARCHIVE_EXTENSION);
+
+    if (strcmp(path, "-") == 0) //Archive streamed on stdin
+        return 1;
+
+    return length > extension && strcmp(path + length - extension, NIRTCONFIG_ARCHIVE_EXTENSION) == 0;
+}
+
+int nirtconfig_createStagingDir(char* stagingDir, size_t bufferSize)
+{
+    const char* tempDir = getenv("TMPDIR");
+
+    if (tempDir == NULL || strlen(tempDir) == 0)
+        tempDir = "/tmp";
+
+    snprintf(stagingDir, bufferSize, "%s/nirtconfig-XXXXXX", tempDir);
+
+    return mkdtemp(stagingDir) == NULL;
+}
+
+int nirtconfig_removeStagingEntry(const char* path, const struct stat* info, int flag, struct FTW* ftwBuffer)
+{
+    return remove(path);
+}
+
+void nirtconfig_removeStagingDir(const char* stagingDir)
+{
+    nftw(stagingDir, nirtconfig_removeStagingEntry, 16, FTW_DEPTH | FTW_PHYS); //Children before parents
+}
+
 int nirtconfig_selfTest(int argc, char** argv)
 {
     if (argc != 3) //Check for correct number of incoming arguments
@@ -229,8 +521,8 @@ int nirtconfig_selfTest(int argc, char** argv)
     NISysCfgSessionHandle session = NULL;
     int status = 0;
 
-    status = NISysCfgInitializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    status = nirtconfig_initializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializeing session
@@ -239,21 +531,22 @@ int nirtconfig_selfTest(int argc, char** argv)
     NISysCfgResourceHandle resource = NULL;
     NISysCfgFilterHandle filter = NULL;
 
-    NISysCfgCreateFilter(session, &filter);
+    nirtconfig_createFilter(session, &filter);
     NISysCfgSetFilterProperty(filter, NISysCfgFilterPropertySlotNumber, 0);
 
-    status = NISysCfgFindHardware(session, NISysCfgFilterModeAllPropertiesExist, filter, NULL, &resourceHandle);
+    status = nirtconfig_findHardware(session, NISysCfgFilterModeAllPropertiesExist, filter, NULL, &resourceHandle);
 
     printf("Running Self Tests...\n");
     printf("%-40s%-20s%-15s%s\n", "RESOURCE NAME", "PRODUCT NAME", "PASS/FAIL", "DETAILED RESULTS");
-    while (NISysCfgNextResource(session, resourceHandle, &resource) == NISysCfg_OK) //Iterate through all hardware resources
+    while (nirtconfig_nextResource(session, resourceHandle, &resource) == NISysCfg_OK) //Iterate through all hardware resources
     {
         nirtconfig_printSelfTestResults(resource);
-        NISysCfgCloseHandle(resource);
+        nirtconfig_closeHandle(resource);
     }
 
-    NISysCfgCloseHandle(resourceHandle);
-    NISysCfgCloseHandle(session);
+    nirtconfig_closeHandle(resourceHandle);
+    nirtconfig_closeHandle(filter);
+    nirtconfig_closeHandle(session);
 
     return status;
 }
@@ -305,8 +598,8 @@ int nirtconfig_setHostname(int argc, char** argv)
     NISysCfgSessionHandle session = NULL;
     int status = 0;
 
-    status = NISysCfgInitializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    status = nirtconfig_initializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializeing session
@@ -321,7 +614,7 @@ int nirtconfig_setHostname(int argc, char** argv)
     NISysCfgSaveSystemChanges(session, &restartRequired, &detailedResults);
 
     NISysCfgFreeDetailedString(detailedResults);
-    NISysCfgCloseHandle(session);
+    nirtconfig_closeHandle(session);
 
     return status;
 }
@@ -337,8 +630,8 @@ int nirtconfig_setIpAddress(int argc, char** argv)
     NISysCfgSessionHandle session = NULL;
     int status = 0;
 
-    status = NISysCfgInitializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    status = nirtconfig_initializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializeing session
@@ -354,7 +647,7 @@ int nirtconfig_setIpAddress(int argc, char** argv)
     status = NISysCfgSaveSystemChanges(session, &restartRequired, &detailedResults);
 
     NISysCfgFreeDetailedString(detailedResults);
-    NISysCfgCloseHandle(session);
+    nirtconfig_closeHandle(session);
 
     return status;
 }
@@ -370,8 +663,8 @@ int nirtconfig_restartTarget(int argc, char** argv)
     NISysCfgSessionHandle session = NULL;
     int status = 0;
 
-    status = NISysCfgInitializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    status = nirtconfig_initializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializeing session
@@ -384,7 +677,7 @@ int nirtconfig_restartTarget(int argc, char** argv)
     if (status == 0)
         printf("Restarted With IP Address: %s\n", ipAddr);
 
-    NISysCfgCloseHandle(session);
+    nirtconfig_closeHandle(session);
 
     return status;
 }
@@ -397,15 +690,21 @@ int nirtconfig_updateFirmware(int argc, char** argv)
         return 0;
     }
 
-    NISysCfgSessionHandle session = NULL;
     char username[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
     char password[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
-    int status = 0;
 
     nirtconfig_getCredentials(argc, argv, username, password);
 
-    status = NISysCfgInitializeSession(argv[argc - 2], username, password, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    return nirtconfig_updateTargetFirmware(argv[argc - 2], argv[argc - 1], username, password);
+}
+
+int nirtconfig_updateTargetFirmware(char* targetName, char* firmwarePath, char* username, char* password)
+{
+    NISysCfgSessionHandle session = NULL;
+    int status = 0;
+
+    status = nirtconfig_initializeSession(targetName, username, password, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializeing session
@@ -416,16 +715,16 @@ int nirtconfig_updateFirmware(int argc, char** argv)
 
     if (nirtconfig_findFirmwareResource(session, &resource) == NISysCfg_OK) //Get hardware resource and set firmware
     {
-        printf("Updating Firmware...\nTarget: %s\nFirmware: %s\n", argv[argc - 2], argv[argc - 1]);
-        status = NISysCfgUpgradeFirmwareFromFile(resource, argv[argc - 1], NISysCfgBoolTrue, NISysCfgBoolTrue,
+        printf("Updating Firmware...\nTarget: %s\nFirmware: %s\n", targetName, firmwarePath);
+        status = NISysCfgUpgradeFirmwareFromFile(resource, firmwarePath, NISysCfgBoolTrue, NISysCfgBoolTrue,
                                                  NISysCfgBoolTrue, &firmwareStatus, &detailedResults);
 
         printf("Firmware Status: %d\nDetailed Results: %s\n", firmwareStatus, detailedResults);
     }
 
     NISysCfgFreeDetailedString(detailedResults);
-    NISysCfgCloseHandle(resource);
-    NISysCfgCloseHandle(session);
+    nirtconfig_closeHandle(resource);
+    nirtconfig_closeHandle(session);
 
     return status;
 }
@@ -458,14 +757,15 @@ int nirtconfig_findFirmwareResource(NISysCfgSessionHandle session, NISysCfgResou
     NISysCfgEnumResourceHandle resourceHandle = NULL;
     NISysCfgFilterHandle filter = NULL;
 
-    NISysCfgCreateFilter(session, &filter);
+    nirtconfig_createFilter(session, &filter);
     NISysCfgSetFilterProperty(filter, NISysCfgFilterPropertySupportsFirmwareUpdate, NISysCfgBoolTrue);
     NISysCfgSetFilterProperty(filter, NISysCfgFilterPropertyResourceName, "system");
 
-    NISysCfgFindHardware(session, NISysCfgFilterModeMatchValuesAll, filter, NULL, &resourceHandle);
-    status = NISysCfgNextResource(session, resourceHandle, resource);
+    nirtconfig_findHardware(session, NISysCfgFilterModeMatchValuesAll, filter, NULL, &resourceHandle);
+    status = nirtconfig_nextResource(session, resourceHandle, resource);
 
-    NISysCfgCloseHandle(resourceHandle);
+    nirtconfig_closeHandle(resourceHandle);
+    nirtconfig_closeHandle(filter);
 
     return status;
 }
@@ -484,28 +784,29 @@ int nirtconfig_ipFromSerialNumber(int argc, char** argv)
     char serialNumber[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
     int status = 0;
 
-    status = NISysCfgFindSystems(NULL, NULL, NISysCfgBoolTrue,
-                                 NISysCfgIncludeCachedResultsOnlyIfOnline, NISysCfgSystemNameFormatIp,
-                                 10000, NISysCfgBoolTrue, &enumSystemHandle);
+    status = nirtconfig_findSystems(NULL, NULL, NISysCfgBoolTrue,
+                                    NISysCfgIncludeCachedResultsOnlyIfOnline, NISysCfgSystemNameFormatIp,
+                                    10000, NISysCfgBoolTrue, &enumSystemHandle);
 
     while (NISysCfgNextSystemInfo(enumSystemHandle, systemIP) == NISysCfg_OK) //Iterate through systems found
     {
-        NISysCfgInitializeSession(systemIP, NULL, NULL, NISysCfgLocaleDefault,
-                                  NISysCfgBoolFalse, 10000, NULL, &session);
+        session = NULL; //Don't reuse the previous system's closed handle if this one fails to connect
+        nirtconfig_initializeSession(systemIP, NULL, NULL, NISysCfgLocaleDefault,
+                                     NISysCfgBoolFalse, 10000, NULL, &session);
 
         NISysCfgGetSystemProperty(session, NISysCfgSystemPropertySerialNumber, serialNumber);
-        NISysCfgCloseHandle(session);
+        nirtconfig_closeHandle(session);
 
         if ((strcmp(argv[2], serialNumber)) == 0) //Found correct target
         {
-            NISysCfgCloseHandle(enumSystemHandle);
+            nirtconfig_closeHandle(enumSystemHandle);
             printf("%s\n", systemIP);
             return 0;
         }
     }
 
     printf("Target With SN %s Not Found\n", argv[2]);
-    NISysCfgCloseHandle(enumSystemHandle);
+    nirtconfig_closeHandle(enumSystemHandle);
 
     return status;
 }
@@ -535,15 +836,15 @@ int nirtconfig_setModuleMode(int argc, char** argv)
     NISysCfgSessionHandle session = NULL;
     int status = 0;
 
-    status = NISysCfgInitializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    status = nirtconfig_initializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializing session
 
     nirtconfig_setAllModuleModes(session, moduleMode);
 
-    NISysCfgCloseHandle(session);
+    nirtconfig_closeHandle(session);
 
     return status;
 }
@@ -556,15 +857,14 @@ void nirtconfig_setAllModuleModes(NISysCfgSessionHandle session, NISysCfgModuleP
     char alias[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
     char productName[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
     NISysCfgBool changesRequired;
-    char* detailedResults;
-    int status = 0;
+    char* detailedResults = NULL;
 
-    NISysCfgCreateFilter(session, &filter);
+    nirtconfig_createFilter(session, &filter);
     NISysCfgSetFilterProperty(filter, NISysCfgFilterPropertyConnectsToBusType, NISysCfgBusTypeCompactRio);
 
-    NISysCfgFindHardware(session, NISysCfgFilterModeMatchValuesAll, filter, NULL, &resourceHandle);
+    nirtconfig_findHardware(session, NISysCfgFilterModeMatchValuesAll, filter, NULL, &resourceHandle);
 
-    while ((NISysCfgNextResource(session, resourceHandle, &resource)) == NISysCfg_OK) //Iterate through all modules
+    while ((nirtconfig_nextResource(session, resourceHandle, &resource)) == NISysCfg_OK) //Iterate through all modules
     {
         NISysCfgGetResourceIndexedProperty(resource, NISysCfgIndexedPropertyExpertUserAlias, 0, alias);
         NISysCfgGetResourceProperty(resource, NISysCfgResourcePropertyProductName, productName);
@@ -573,11 +873,13 @@ void nirtconfig_setAllModuleModes(NISysCfgSessionHandle session, NISysCfgModuleP
         NISysCfgSetResourceProperty(resource, NISysCfgResourcePropertyModuleProgramMode, moduleMode);
 
         NISysCfgSaveResourceChanges(resource, &changesRequired, &detailedResults);
-        NISysCfgCloseHandle(resource);
+        NISysCfgFreeDetailedString(detailedResults); //Each save allocates a new string
+        detailedResults = NULL;
+        nirtconfig_closeHandle(resource);
     }
 
-    NISysCfgFreeDetailedString(detailedResults);
-    NISysCfgCloseHandle(resourceHandle);
+    nirtconfig_closeHandle(resourceHandle);
+    nirtconfig_closeHandle(filter);
 }
 
 int nirtconfig_listHardware(int argc, char** argv)
@@ -591,8 +893,8 @@ int nirtconfig_listHardware(int argc, char** argv)
     NISysCfgSessionHandle session = NULL;
     int status = 0;
 
-    status = NISysCfgInitializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    status = nirtconfig_initializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializing session
@@ -601,20 +903,21 @@ int nirtconfig_listHardware(int argc, char** argv)
     NISysCfgResourceHandle resource = NULL;
     NISysCfgFilterHandle filter = NULL;
 
-    NISysCfgCreateFilter(session, &filter);
+    nirtconfig_createFilter(session, &filter);
     NISysCfgSetFilterProperty(filter, NISysCfgFilterPropertySlotNumber, 0);
 
-    status = NISysCfgFindHardware(session, NISysCfgFilterModeAllPropertiesExist, filter, NULL, &resourceHandle);
+    status = nirtconfig_findHardware(session, NISysCfgFilterModeAllPropertiesExist, filter, NULL, &resourceHandle);
 
     printf("%-10s%-15s%s\n", "SLOT", "MODULE", "ALIAS");
-    while (NISysCfgNextResource(session, resourceHandle, &resource) == NISysCfg_OK) //Iterate through all hardware resources
+    while (nirtconfig_nextResource(session, resourceHandle, &resource) == NISysCfg_OK) //Iterate through all hardware resources
     {
         nirtconfig_printHardwareList(resource);
-        NISysCfgCloseHandle(resource);
+        nirtconfig_closeHandle(resource);
     }
 
-    NISysCfgCloseHandle(resourceHandle);
-    NISysCfgCloseHandle(session);
+    nirtconfig_closeHandle(resourceHandle);
+    nirtconfig_closeHandle(filter);
+    nirtconfig_closeHandle(session);
 
     return status;
 }
@@ -654,8 +957,8 @@ int nirtconfig_format(int argc, char** argv)
 
     nirtconfig_getCredentials(argc, argv, username, password);
 
-    status = NISysCfgInitializeSession(argv[argc - 1], username, password, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    status = nirtconfig_initializeSession(argv[argc - 1], username, password, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializeing session
@@ -665,6 +968,7 @@ int nirtconfig_format(int argc, char** argv)
     status = NISysCfgFormat(session, NISysCfgBoolTrue, NISysCfgBoolTrue,
                             NISysCfgFileSystemDefault, NISysCfgPreservePrimaryResetOthers, 120000);
 
+    nirtconfig_closeHandle(session);
     return status;
 }
 
@@ -673,14 +977,18 @@ int nirtconfig_setAlias(int argc, char** argv)
     if (argc != 5) //Check for correct number of incoming arguments
     {
         printf("Error Expecting Arguments: setalias <TARGETNAME> <SLOT> <NEW_ALIAS>\n");
+        printf("                           setalias <TARGETNAME> --map <ALIAS_CSV>\n");
         return 0;
     }
 
+    if (strcmp(argv[3], "--map") == 0) //Rename every slot listed in the CSV
+        return nirtconfig_setAliasMap(argv[2], argv[4]);
+
     NISysCfgSessionHandle session = NULL;
     int status = 0;
 
-    status = NISysCfgInitializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
-                                       NISysCfgBoolFalse, 10000, NULL, &session);
+    status = nirtconfig_initializeSession(argv[2], NULL, NULL, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
 
     if (status != 0)
         return status; //Error initializeing session
@@ -693,16 +1001,1105 @@ int nirtconfig_setAlias(int argc, char** argv)
     int slotNumber = 0;
     sscanf(argv[3], "%d", &slotNumber); //convert char argument to int
 
-    NISysCfgCreateFilter(session, &filter);
+    nirtconfig_createFilter(session, &filter);
     NISysCfgSetFilterProperty(filter, NISysCfgFilterPropertySlotNumber, slotNumber);
 
-    NISysCfgFindHardware(session, NISysCfgFilterModeMatchValuesAll, filter, NULL, &resourceHandle);
-    NISysCfgNextResource(session, resourceHandle, &resource);
+    nirtconfig_findHardware(session, NISysCfgFilterModeMatchValuesAll, filter, NULL, &resourceHandle);
+    nirtconfig_nextResource(session, resourceHandle, &resource);
+
+    status = nirtconfig_renameResource(resource, argv[4], NISysCfgBoolFalse, NISysCfgBoolTrue, &nameExisted, &overwrittenResource);
+
+    nirtconfig_closeHandle(overwrittenResource);
+    nirtconfig_closeHandle(resource);
+    nirtconfig_closeHandle(resourceHandle);
+    nirtconfig_closeHandle(filter);
+    nirtconfig_closeHandle(session);
+
+    return status;
+}
+
+int nirtconfig_setAliasMap(char* targetName, char* mapFile)
+{
+    struct hwNode* aliasMap = NULL;
+    NISysCfgSessionHandle session = NULL;
+    int status = 0;
+
+    if (nirtconfig_readAliasMap(mapFile, &aliasMap) != 0)
+        return 1;
+
+    status = nirtconfig_initializeSession(targetName, NULL, NULL, NISysCfgLocaleDefault,
+                                          NISysCfgBoolFalse, 10000, NULL, &session);
+
+    if (status != 0)
+    {
+        nirtconfig_freeHardwareList(aliasMap);
+        return status; //Error initializeing session
+    }
+
+    NISysCfgEnumResourceHandle resourceHandle = NULL;
+    NISysCfgResourceHandle resource = NULL;
+    NISysCfgFilterHandle filter = NULL;
+    NISysCfgResourceHandle slotIndex[NIRTCONFIG_MAX_SLOTS] = {};
+    char serialNumber[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
+    int slotNumber = 0;
+
+    nirtconfig_createFilter(session, &filter);
+    NISysCfgSetFilterProperty(filter, NISysCfgFilterPropertySlotNumber, 0);
+
+    //Enumerate the chassis once and index modules by slot, rather than one search per alias
+    status = nirtconfig_findHardware(session, NISysCfgFilterModeAllPropertiesExist, filter, NULL, &resourceHandle);
+
+    while (nirtconfig_nextResource(session, resourceHandle, &resource) == NISysCfg_OK) //Iterate through all hardware resources
+    {
+        strcpy(serialNumber, "");
+        NISysCfgGetResourceProperty(resource, NISysCfgResourcePropertySlotNumber, &slotNumber);
+        NISysCfgGetResourceProperty(resource, NISysCfgResourcePropertySerialNumber, serialNumber);
+
+        // Skip resources without a SN, PXIe controllers list GPIB ports as a unique resource in slot 1
+        if (strcmp(serialNumber, "") != 0 && slotNumber >= 0 && slotNumber < NIRTCONFIG_MAX_SLOTS && slotIndex[slotNumber] == NULL)
+            slotIndex[slotNumber] = resource;
+        else
+            nirtconfig_closeHandle(resource);
+    }
+
+    nirtconfig_closeHandle(resourceHandle);
+    nirtconfig_closeHandle(filter);
+
+    int renamed = 0;
+    int conflicts = 0;
+    int missing = 0;
+    int errors = 0;
+
+    printf("%-10s%-20s%-30s%s\n", "SLOT", "MODULE", "ALIAS", "RESULT");
+    for (struct hwNode* node = aliasMap; node != NULL; node = node->next) //Apply every rename in this session
+    {
+        char productName[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
+        NISysCfgBool nameExisted = NISysCfgBoolFalse;
+        NISysCfgResourceHandle overwrittenResource = NULL;
+        int renameStatus = 0;
+
+        resource = node->slot >= 0 && node->slot < NIRTCONFIG_MAX_SLOTS ? slotIndex[node->slot] : NULL;
+        if (resource == NULL)
+        {
+            printf("%-10d%-20s%-30s%s\n", node->slot, "", node->alias, "No Module In Slot");
+            missing++;
+            continue;
+        }
+
+        NISysCfgGetResourceProperty(resource, NISysCfgResourcePropertyProductName, productName);
+
+        renameStatus = nirtconfig_renameResource(resource, node->alias, NISysCfgBoolFalse, NISysCfgBoolTrue, &nameExisted, &overwrittenResource);
+
+        //Some drivers also return an error status for a collision, so check for the conflict first
+        if (nameExisted) //Alias held by another resource, left untouched
+        {
+            printf("%-10d%-20s%-30s%s\n", node->slot, productName, node->alias, "Conflict: Alias Already In Use");
+            conflicts++;
+        }
+        else if (renameStatus != 0)
+        {
+            printf("%-10d%-20s%-30sError: %d\n", node->slot, productName, node->alias, renameStatus);
+            errors++;
+            if (status == 0)
+                status = renameStatus;
+        }
+        else
+        {
+            printf("%-10d%-20s%-30s%s\n", node->slot, productName, node->alias, "Renamed");
+            renamed++;
+        }
+
+        nirtconfig_closeHandle(overwrittenResource);
+    }
+
+    printf("Renamed %d, Conflicts %d, Missing %d, Errors %d\n", renamed, conflicts, missing, errors);
+
+    if (status == 0 && (conflicts > 0 || missing > 0))
+        status = 1; //Chassis not fully labelled
 
-    status = NISysCfgRenameResource(resource, argv[4], NISysCfgBoolFalse, NISysCfgBoolTrue, &nameExisted, &overwrittenResource);
+    for (int i = 0; i < NIRTCONFIG_MAX_SLOTS; i++)
+        nirtconfig_closeHandle(slotIndex[i]);
 
-    NISysCfgCloseHandle(resourceHandle);
-    NISysCfgCloseHandle(session);
+    nirtconfig_closeHandle(session);
+    nirtconfig_freeHardwareList(aliasMap);
 
     return status;
-}
\ No newline at end of file
+}
+
+int nirtconfig_readAliasMap(char* mapFile, struct hwNode** aliasMap)
+{
+    FILE* file = fopen(mapFile, "r");
+    char line[NISYSCFG_SIMPLE_STRING_LENGTH + 32] = "";
+    char alias[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
+    char first[2] = "";
+    struct hwNode** tail = aliasMap;
+    int slotNumber = 0;
+    int lineNumber = 0;
+    int rows = 0;
+
+    if (file == NULL)
+    {
+        printf("Unable To Open Alias Map: %s\n", mapFile);
+        return 1;
+    }
+
+    //Each line: <SLOT>,<NEW_ALIAS>. Blank lines, # comments and a header row are skipped
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        lineNumber++;
+
+        if (sscanf(line, " %1s", first) != 1 || first[0] == '#')
+            continue; //blank line or comment
+
+        if (sscanf(line, " %d , %1023[^,\r\n]", &slotNumber, alias) != 2)
+        {
+            if (lineNumber > 1 || isdigit((unsigned char)first[0])) //First line may be a header row
+                printf("Skipping Line %d: Expected <SLOT>,<NEW_ALIAS>\n", lineNumber);
+            continue;
+        }
+
+        for (int i = strlen(alias) - 1; i >= 0 && alias[i] == ' '; i--) //Trim trailing spaces
+            alias[i] = '\0';
+
+        struct hwNode* node = (struct hwNode*)calloc(1, sizeof(struct hwNode));
+        node->slot = slotNumber;
+        node->alias = strdup(alias);
+
+        *tail = node; //Keep file order so renames apply top to bottom
+        tail = &node->next;
+        rows++;
+    }
+
+    fclose(file);
+
+    if (rows == 0)
+    {
+        printf("No Aliases Found In %s\n", mapFile);
+        return 1;
+    }
+
+    return 0;
+}
+
+void nirtconfig_freeHardwareList(struct hwNode* list)
+{
+    while (list != NULL)
+    {
+        struct hwNode* next = list->next;
+
+        free(list->alias);
+        free(list->productName);
+        free(list);
+        list = next;
+    }
+}
+
+int nirtconfig_scheduleTransfers(int argc, char** argv)
+{
+    if (argc < 3) //Check for correct number of incoming arguments
+    {
+        printf("Error Expecting Arguments: schedule <JOBFILE> [-b AGGREGATE_MBPS] [-r TRANSFER_MBPS] [-s SUBNET_LIMIT]\n");
+        return 0;
+    }
+
+    struct transferScheduler scheduler = {};
+    char* jobFile = argv[2]; //read before getopt permutes argv
+    double aggregateMbps = 500;
+    double transferMbps = 100;
+    int status = 0;
+
+    scheduler.subnetLimit = 2;
+    if (nirtconfig_getScheduleOptions(argc, argv, &aggregateMbps, &transferMbps, &scheduler.subnetLimit) != 0)
+        return 0; //Invalid option already reported
+
+    if (aggregateMbps <= 0 || transferMbps <= 0 || scheduler.subnetLimit < 1)
+    {
+        printf("Error: -b and -r must be greater than 0 and -s at least 1\n");
+        return 0;
+    }
+
+    status = nirtconfig_readTransferJobs(jobFile, &scheduler);
+    if (status != 0 || scheduler.jobCount == 0)
+    {
+        printf("No Transfer Jobs Found In %s\n", jobFile);
+        free(scheduler.jobs);
+        return status;
+    }
+
+    printf("Sizing %d Transfers...\n", scheduler.jobCount);
+    for (int i = 0; i < scheduler.jobCount; i++)
+        nirtconfig_planTransferJob(&scheduler.jobs[i]);
+
+    //Largest job first keeps the longest transfers from landing at the end of the schedule
+    qsort(scheduler.jobs, scheduler.jobCount, sizeof(struct transferJob), nirtconfig_compareTransferJobs);
+
+    //NISysCfg transfers cannot be rate limited, so the bandwidth budget caps how many run at once
+    int workerCount = (int)(aggregateMbps / transferMbps);
+    if (workerCount < 1)
+        workerCount = 1;
+    if (workerCount > scheduler.jobCount)
+        workerCount = scheduler.jobCount;
+
+    printf("Running %d Transfers: %d Concurrent (%.0f of %.0f Mbit/s), %d Per Subnet\n", scheduler.jobCount,
+           workerCount, workerCount * transferMbps, aggregateMbps, scheduler.subnetLimit);
+
+    pthread_t* workers = (pthread_t*)malloc(workerCount * sizeof(pthread_t));
+    struct timespec start, end;
+
+    pthread_mutex_init(&scheduler.lock, NULL);
+    pthread_cond_init(&scheduler.jobFinished, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < workerCount; i++)
+        pthread_create(&workers[i], NULL, nirtconfig_transferWorker, &scheduler);
+
+    for (int i = 0; i < workerCount; i++)
+        pthread_join(workers[i], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_cond_destroy(&scheduler.jobFinished);
+    pthread_mutex_destroy(&scheduler.lock);
+
+    nirtconfig_printTransferReport(&scheduler, nirtconfig_elapsedSeconds(&start, &end));
+
+    for (int i = 0; i < scheduler.jobCount; i++) //Report first failure
+    {
+        if (scheduler.jobs[i].status != 0)
+        {
+            status = scheduler.jobs[i].status;
+            break;
+        }
+    }
+
+    free(workers);
+    free(scheduler.jobs);
+
+    return status;
+}
+
+int nirtconfig_getScheduleOptions(int argc, char** argv, double* aggregateMbps, double* transferMbps, int* subnetLimit)
+{
+    int flag;
+    int parsed = 1;
+
+    while ((flag = getopt(argc, argv, "b:r:s:")) != -1) //search through incoming arguments
+    {
+        switch (flag)
+        {
+            case 'b':
+                parsed = sscanf(optarg, "%lf", aggregateMbps);
+                break;
+
+            case 'r':
+                parsed = sscanf(optarg, "%lf", transferMbps);
+                break;
+
+            case 's':
+                parsed = sscanf(optarg, "%d", subnetLimit);
+                break;
+
+            default:
+                break;
+        }
+
+        if (parsed != 1)
+        {
+            printf("Invalid Value For -%c: %s\n", flag, optarg);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int nirtconfig_readTransferJobs(char* jobFile, struct transferScheduler* scheduler)
+{
+    FILE* file = fopen(jobFile, "r");
+    char line[4 * NISYSCFG_SIMPLE_STRING_LENGTH] = "";
+    struct transferJob job;
+    int lineNumber = 0;
+
+    if (file == NULL)
+    {
+        printf("Unable To Open Job File: %s\n", jobFile);
+        return 1;
+    }
+
+    //Each line: <setimage|getimage|updatefirmware> <TARGETNAME> [PATH] [USERNAME PASSWORD]
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        lineNumber++;
+        memset(&job, 0, sizeof(job));
+
+        if (sscanf(line, "%15s %1023s %1023s %1023s %1023s", job.command, job.target,
+                   job.path, job.username, job.password) < 2)
+            continue; //blank line
+
+        if (job.command[0] == '#')
+            continue; //comment
+
+        if (strcmp(job.command, "setimage") != 0 && strcmp(job.command, "getimage") != 0
+            && strcmp(job.command, "updatefirmware") != 0)
+        {
+            printf("Skipping Line %d: Unsupported Command \"%s\"\n", lineNumber, job.command);
+            continue;
+        }
+
+        if (strcmp(job.command, "getimage") != 0 && strlen(job.path) == 0)
+        {
+            printf("Skipping Line %d: %s Requires A Path\n", lineNumber, job.command);
+            continue;
+        }
+
+        if (strcmp(job.command, "getimage") == 0) //getimage lines may carry credentials in place of a path
+        {
+            strcpy(job.password, job.username);
+            strcpy(job.username, job.path);
+            strcpy(job.path, "");
+        }
+
+        scheduler->jobs = (struct transferJob*)realloc(scheduler->jobs, (scheduler->jobCount + 1) * sizeof(struct transferJob));
+        scheduler->jobs[scheduler->jobCount++] = job;
+    }
+
+    fclose(file);
+
+    return 0;
+}
+
+void nirtconfig_planTransferJob(struct transferJob* job)
+{
+    NISysCfgSessionHandle session = NULL;
+    char ipAddr[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
+    char subnetMask[NISYSCFG_SIMPLE_STRING_LENGTH] = "";
+    double diskTotal = 0;
+    double diskFree = 0;
+
+    if (nirtconfig_initializeSession(job->target, job->username, job->password, NISysCfgLocaleDefault,
+                                     NISysCfgBoolFalse, 10000, NULL, &session)
+        == NISysCfg_OK)
+    {
+        NISysCfgGetSystemProperty(session, NISysCfgSystemPropertyIpAddress, ipAddr);
+        NISysCfgGetSystemProperty(session, NISysCfgSystemPropertySubnetMask, subnetMask);
+
+        //The captured image is roughly the used space of the primary disk
+        if (strcmp(job->command, "getimage") == 0
+            && NISysCfgGetSystemProperty(session, NISysCfgSystemPropertyPrimaryDiskTotal, &diskTotal) == NISysCfg_OK
+            && NISysCfgGetSystemProperty(session, NISysCfgSystemPropertyPrimaryDiskFree, &diskFree) == NISysCfg_OK)
+            job->bytes = diskTotal - diskFree;
+
+        nirtconfig_closeHandle(session);
+    }
+
+    if (strcmp(job->command, "getimage") != 0) //Image folder or firmware file being pushed
+        job->bytes = nirtconfig_getPathSize(job->path);
+
+    //Archives are sized by their compressed bytes and timed including the unpack, so the report flags them
+    job->isArchive = strcmp(job->command, "setimage") == 0 && nirtconfig_isImageArchive(job->path);
+
+    nirtconfig_buildSubnet(job->target, ipAddr, subnetMask, job->subnet);
+}
+
+void nirtconfig_buildSubnet(char* targetName, char* ipAddr, char* subnetMask, char* subnet)
+{
+    struct in_addr address;
+    struct in_addr mask;
+
+    if (inet_pton(AF_INET, ipAddr, &address) != 1 && inet_pton(AF_INET, targetName, &address) != 1)
+    {
+        strcpy(subnet, targetName); //Unreachable target, give it a subnet of its own
+        return;
+    }
+
+    if (inet_pton(AF_INET, subnetMask, &mask) != 1)
+        inet_pton(AF_INET, "255.255.255.0", &mask);
+
+    address.s_addr &= mask.s_addr;
+    inet_ntop(AF_INET, &address, subnet, NISYSCFG_SIMPLE_STRING_LENGTH);
+}
+
+double nirtconfig_getPathSize(const char* path)
+{
+    struct stat info;
+    struct dirent* entry;
+    char childPath[PATH_MAX] = "";
+    double size = 0;
+
+    if (lstat(path, &info) != 0)
+        return 0;
+
+    if (!S_ISDIR(info.st_mode))
+        return info.st_size;
+
+    DIR* dir = opendir(path);
+    if (dir == NULL)
+        return 0;
+
+    while ((entry = readdir(dir)) != NULL) //Sum every file below an image folder
+    {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        snprintf(childPath, sizeof(childPath), "%s/%s", path, entry->d_name);
+        size += nirtconfig_getPathSize(childPath);
+    }
+
+    closedir(dir);
+
+    return size;
+}
+
+int nirtconfig_compareTransferJobs(const void* a, const void* b)
+{
+    double sizeA = ((const struct transferJob*)a)->bytes;
+    double sizeB = ((const struct transferJob*)b)->bytes;
+
+    return (sizeA < sizeB) - (sizeA > sizeB); //descending by size
+}
+
+void* nirtconfig_transferWorker(void* arg)
+{
+    struct transferScheduler* scheduler = (struct transferScheduler*)arg;
+    struct transferJob* job = NULL;
+
+    pthread_mutex_lock(&scheduler->lock);
+
+    while (1)
+    {
+        job = nirtconfig_nextTransferJob(scheduler);
+
+        if (job != NULL) //Run job outside the lock so other workers can start theirs
+        {
+            job->state = TRANSFER_RUNNING;
+            pthread_mutex_unlock(&scheduler->lock);
+
+            nirtconfig_runTransferJob(job);
+
+            pthread_mutex_lock(&scheduler->lock);
+            job->state = TRANSFER_DONE;
+            pthread_cond_broadcast(&scheduler->jobFinished);
+        }
+        else if (nirtconfig_transfersPending(scheduler))
+            pthread_cond_wait(&scheduler->jobFinished, &scheduler->lock); //Subnet budget full, wait for a slot
+        else
+            break;
+    }
+
+    pthread_mutex_unlock(&scheduler->lock);
+
+    return NULL;
+}
+
+struct transferJob* nirtconfig_nextTransferJob(struct transferScheduler* scheduler)
+{
+    for (int i = 0; i < scheduler->jobCount; i++) //Jobs are sorted, so the first startable job is the largest
+    {
+        struct transferJob* job = &scheduler->jobs[i];
+        int running = 0;
+
+        if (job->state != TRANSFER_PENDING)
+            continue;
+
+        for (int j = 0; j < scheduler->jobCount; j++) //Count transfers already running on this subnet
+        {
+            if (scheduler->jobs[j].state == TRANSFER_RUNNING && strcmp(scheduler->jobs[j].subnet, job->subnet) == 0)
+                running++;
+        }
+
+        if (running < scheduler->subnetLimit)
+            return job;
+    }
+
+    return NULL;
+}
+
+int nirtconfig_transfersPending(struct transferScheduler* scheduler)
+{
+    for (int i = 0; i < scheduler->jobCount; i++)
+    {
+        if (scheduler->jobs[i].state == TRANSFER_PENDING)
+            return 1;
+    }
+
+    return 0;
+}
+
+void nirtconfig_runTransferJob(struct transferJob* job)
+{
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (strcmp(job->command, "setimage") == 0)
+        job->status = nirtconfig_setTargetImage(job->target, job->username, job->password, job->path);
+    else if (strcmp(job->command, "getimage") == 0)
+        job->status = nirtconfig_getTargetImage(job->target, job->username, job->password, job->path, sizeof(job->path), NULL);
+    else
+        job->status = nirtconfig_updateTargetFirmware(job->target, job->path, job->username, job->password);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    job->seconds = nirtconfig_elapsedSeconds(&start, &end);
+
+    if (strcmp(job->command, "getimage") == 0 && job->status == 0) //Replace estimate with captured size
+        job->bytes = nirtconfig_getPathSize(job->path);
+}
+
+double nirtconfig_elapsedSeconds(struct timespec* start, struct timespec* end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void nirtconfig_printTransferReport(struct transferScheduler* scheduler, double makespan)
+{
+    double totalBytes = 0;
+    int archiveJobs = 0;
+
+    printf("%-16s%-35s%-18s%-12s%-12s%-15s%s\n", "COMMAND", "TARGET", "SUBNET", "SIZE (MB)", "TIME (s)", "RATE (Mbit/s)", "STATUS");
+
+    for (int i = 0; i < scheduler->jobCount; i++)
+    {
+        struct transferJob* job = &scheduler->jobs[i];
+        char command[sizeof(job->command) + 1] = "";
+        char rate[32] = "-";
+
+        //A failed job never moved its planned bytes, so it gets no rate and stays out of the totals
+        if (job->status == 0)
+        {
+            snprintf(rate, sizeof(rate), "%.1f", job->seconds > 0 ? job->bytes * 8 / 1e6 / job->seconds : 0);
+            totalBytes += job->bytes;
+        }
+
+        snprintf(command, sizeof(command), "%s%s", job->command, job->isArchive ? "*" : "");
+        printf("%-16s%-35s%-18s%-12.1f%-12.1f%-15s%d\n", command, job->target, job->subnet,
+               job->bytes / 1e6, job->seconds, rate, job->status);
+        archiveJobs += job->isArchive;
+    }
+
+    printf("Total: %.1f MB in %.1f s (%.1f Mbit/s aggregate)\n", totalBytes / 1e6, makespan,
+           makespan > 0 ? totalBytes * 8 / 1e6 / makespan : 0);
+
+    if (archiveJobs > 0)
+        printf("* Archive image: size is the compressed archive and time includes unpacking, so the rate understates the link\n");
+}
+
+int nirtconfig_packImageArchive(const char* imageFolder, const char* archivePath)
+{
+    struct archiveWriter writer = {};
+    std::string manifest;
+    const char* folderName = strrchr(imageFolder, '/');
+    char endBlocks[2 * NIRTCONFIG_ARCHIVE_BLOCK] = {};
+    int status = 0;
+
+    folderName = folderName != NULL ? folderName + 1 : imageFolder;
+
+    writer.out = strcmp(archivePath, "-") == 0 ? stdout : fopen(archivePath, "wb");
+    if (writer.out == NULL)
+    {
+        printf("Unable To Open Archive: %s\n", archivePath);
+        return 1;
+    }
+
+    //Compress on every core while the folder is read, so the archive is written in a single pass
+    writer.cctx = ZSTD_createCCtx();
+    writer.outSize = ZSTD_CStreamOutSize();
+    writer.outBuffer = (char*)malloc(writer.outSize);
+
+    if (writer.cctx == NULL || writer.outBuffer == NULL)
+    {
+        fprintf(stderr, "Unable To Allocate Compressor\n");
+        status = 1;
+    }
+    else if (ZSTD_isError(ZSTD_CCtx_setParameter(writer.cctx, ZSTD_c_checksumFlag, 1)))
+    {
+        fprintf(stderr, "Unable To Enable Archive Checksum\n");
+        status = 1;
+    }
+    else if (ZSTD_isError(ZSTD_CCtx_setParameter(writer.cctx, ZSTD_c_nbWorkers, (int)sysconf(_SC_NPROCESSORS_ONLN))))
+        fprintf(stderr, "Warning: libzstd Built Without Multithreading, Compressing On One Thread\n");
+
+    if (status == 0)
+        status = nirtconfig_packArchiveEntry(&writer, imageFolder, folderName, &manifest);
+
+    if (status == 0) //Manifest goes last so it covers every file written before it
+        status = nirtconfig_writeArchiveFile(&writer, NIRTCONFIG_ARCHIVE_MANIFEST, manifest.data(), manifest.size());
+
+    if (status == 0)
+        status = nirtconfig_archiveWrite(&writer, endBlocks, sizeof(endBlocks), ZSTD_e_end);
+
+    ZSTD_freeCCtx(writer.cctx);
+    free(writer.outBuffer);
+
+    //Buffered data is only written here, so a failed close means a truncated archive
+    if (writer.out != stdout)
+    {
+        if (fclose(writer.out) != 0)
+            status = 1;
+    }
+    else if (fflush(stdout) != 0)
+        status = 1;
+
+    if (status != 0)
+    {
+        fprintf(stderr, "Error Writing Archive: %s\n", archivePath);
+
+        //Never leave a partial archive that looks like a good backup, but only remove regular files
+        struct stat info;
+        if (writer.out != stdout && stat(archivePath, &info) == 0 && S_ISREG(info.st_mode))
+            unlink(archivePath);
+    }
+
+    return status;
+}
+
+int nirtconfig_packArchiveEntry(struct archiveWriter* writer, const char* path, const char* entryName, std::string* manifest)
+{
+    struct stat info;
+    char entryPath[PATH_MAX] = "";
+    int status = 0;
+
+    if (lstat(path, &info) != 0)
+        return 1;
+
+    if (S_ISREG(info.st_mode))
+    {
+        FILE* file = fopen(path, "rb");
+        size_t chunkSize = ZSTD_CStreamInSize();
+        char* chunk = (char*)malloc(chunkSize);
+        char padding[NIRTCONFIG_ARCHIVE_BLOCK] = {};
+        char manifestLine[PATH_MAX + 64] = "";
+        unsigned long long remaining = info.st_size;
+        unsigned int crc = 0;
+
+        if (file == NULL)
+            status = 1;
+        else
+            status = nirtconfig_writeArchiveHeader(writer, entryName, info.st_size, '0', &info);
+
+        while (status == 0 && remaining > 0) //Stream file contents through the compressor
+        {
+            //Never read past the size already written to the header, even if the file grew
+            size_t length = fread(chunk, 1, remaining < chunkSize ? remaining : chunkSize, file);
+            if (length == 0)
+            {
+                status = 1; //File shrank while packing
+                break;
+            }
+
+            crc = nirtconfig_crc32(crc, chunk, length);
+            status = nirtconfig_archiveWrite(writer, chunk, length, ZSTD_e_continue);
+            remaining -= length;
+        }
+
+        if (status == 0 && info.st_size % NIRTCONFIG_ARCHIVE_BLOCK != 0)
+            status = nirtconfig_archiveWrite(writer, padding, NIRTCONFIG_ARCHIVE_BLOCK - info.st_size % NIRTCONFIG_ARCHIVE_BLOCK, ZSTD_e_continue);
+
+        snprintf(manifestLine, sizeof(manifestLine), "%08x %llu %s\n", crc, (unsigned long long)info.st_size, entryName);
+        manifest->append(manifestLine);
+
+        if (file != NULL)
+            fclose(file);
+        free(chunk);
+
+        return status;
+    }
+
+    if (!S_ISDIR(info.st_mode))
+    {
+        fprintf(stderr, "Skipping Unsupported File: %s\n", path);
+        return 0;
+    }
+
+    snprintf(entryPath, sizeof(entryPath), "%s/", entryName);
+    status = nirtconfig_writeArchiveHeader(writer, entryPath, 0, '5', &info);
+
+    DIR* dir = opendir(path);
+    struct dirent* entry;
+    char childPath[PATH_MAX] = "";
+
+    if (dir == NULL)
+        return 1;
+
+    while (status == 0 && (entry = readdir(dir)) != NULL) //Recurse into image folder
+    {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        snprintf(childPath, sizeof(childPath), "%s/%s", path, entry->d_name);
+        snprintf(entryPath, sizeof(entryPath), "%s/%s", entryName, entry->d_name);
+        status = nirtconfig_packArchiveEntry(writer, childPath, entryPath, manifest);
+    }
+
+    closedir(dir);
+
+    return status;
+}
+
+int nirtconfig_writeArchiveFile(struct archiveWriter* writer, const char* entryName, const char* data, size_t length)
+{
+    struct stat info = {};
+    char padding[NIRTCONFIG_ARCHIVE_BLOCK] = {};
+    int status = 0;
+
+    info.st_mode = 0644;
+    info.st_mtime = time(NULL);
+
+    status = nirtconfig_writeArchiveHeader(writer, entryName, length, '0', &info);
+
+    if (status == 0)
+        status = nirtconfig_archiveWrite(writer, data, length, ZSTD_e_continue);
+
+    if (status == 0 && length % NIRTCONFIG_ARCHIVE_BLOCK != 0)
+        status = nirtconfig_archiveWrite(writer, padding, NIRTCONFIG_ARCHIVE_BLOCK - length % NIRTCONFIG_ARCHIVE_BLOCK, ZSTD_e_continue);
+
+    return status;
+}
+
+int nirtconfig_writeArchiveHeader(struct archiveWriter* writer, const char* entryName, unsigned long long size, char type, const struct stat* info)
+{
+    char header[NIRTCONFIG_ARCHIVE_BLOCK] = {};
+    const char* name = entryName;
+    size_t prefixLength = 0;
+    unsigned int checksum = 0;
+
+    if (strlen(entryName) > 100) //Split long paths across the ustar prefix and name fields
+    {
+        name = NULL;
+        for (const char* slash = strchr(entryName, '/'); slash != NULL; slash = strchr(slash + 1, '/'))
+        {
+            if (slash[1] != '\0' && strlen(slash + 1) <= 100 && (size_t)(slash - entryName) <= 155)
+            {
+                prefixLength = slash - entryName;
+                name = slash + 1;
+                break;
+            }
+        }
+
+        if (name == NULL)
+        {
+            fprintf(stderr, "Path Too Long For Archive: %s\n", entryName);
+            return 1;
+        }
+    }
+
+    if (size > 077777777777ULL)
+    {
+        fprintf(stderr, "File Too Large For Archive: %s\n", entryName);
+        return 1;
+    }
+
+    strncpy(header, name, 100);
+    snprintf(header + 100, 8, "%07o", (unsigned int)(info->st_mode & 07777));
+    snprintf(header + 108, 8, "%07o", 0);
+    snprintf(header + 116, 8, "%07o", 0);
+    snprintf(header + 124, 12, "%011llo", size);
+    snprintf(header + 136, 12, "%011llo", (unsigned long long)info->st_mtime);
+    header[156] = type;
+    memcpy(header + 257, "ustar", 6);
+    memcpy(header + 263, "00", 2);
+    memcpy(header + 345, entryName, prefixLength);
+
+    memset(header + 148, ' ', 8); //Checksum is computed with its own field blank
+    for (int i = 0; i < NIRTCONFIG_ARCHIVE_BLOCK; i++)
+        checksum += (unsigned char)header[i];
+    snprintf(header + 148, 8, "%06o", checksum);
+    header[155] = ' ';
+
+    return nirtconfig_archiveWrite(writer, header, sizeof(header), ZSTD_e_continue);
+}
+
+int nirtconfig_archiveWrite(struct archiveWriter* writer, const void* data, size_t length, ZSTD_EndDirective mode)
+{
+    ZSTD_inBuffer input = { data, length, 0 };
+    int finished = 0;
+
+    while (!finished) //Feed compressor until it has consumed (and for ZSTD_e_end, flushed) everything
+    {
+        ZSTD_outBuffer output = { writer->outBuffer, writer->outSize, 0 };
+        size_t remaining = ZSTD_compressStream2(writer->cctx, &output, &input, mode);
+
+        if (ZSTD_isError(remaining) || fwrite(writer->outBuffer, 1, output.pos, writer->out) != output.pos)
+            return 1;
+
+        finished = mode == ZSTD_e_end ? remaining == 0 : input.pos == input.size;
+    }
+
+    return 0;
+}
+
+int nirtconfig_unpackImageArchive(const char* archivePath, const char* stagingDir, char* imageFolder, size_t bufferSize)
+{
+    struct archiveReader reader = {};
+    std::string manifest;
+    std::string archivedManifest;
+    char header[NIRTCONFIG_ARCHIVE_BLOCK];
+    char entryName[PATH_MAX] = "";
+    char entryPath[PATH_MAX] = "";
+    int complete = 0;
+    int status = 0;
+
+    reader.in = strcmp(archivePath, "-") == 0 ? stdin : fopen(archivePath, "rb");
+    if (reader.in == NULL)
+    {
+        printf("Unable To Open Archive: %s\n", archivePath);
+        return 1;
+    }
+
+    reader.dctx = ZSTD_createDCtx();
+    reader.inSize = ZSTD_DStreamInSize();
+    reader.inBuffer = (char*)malloc(reader.inSize);
+    reader.input.src = reader.inBuffer;
+    reader.outSize = ZSTD_DStreamOutSize();
+    reader.outBuffer = (char*)malloc(reader.outSize);
+    reader.frameRemaining = 1; //No frame decoded yet
+
+    if (reader.dctx == NULL || reader.inBuffer == NULL || reader.outBuffer == NULL)
+    {
+        printf("Unable To Allocate Decompressor\n");
+        status = 1;
+    }
+
+    printf("Unpacking Archive: %s\n", archivePath);
+
+    while (status == 0 && nirtconfig_archiveRead(&reader, header, sizeof(header)) == sizeof(header))
+    {
+        if (nirtconfig_isZeroBlock(header)) //End-of-archive marker is two zero blocks
+        {
+            complete = nirtconfig_archiveRead(&reader, header, sizeof(header)) == sizeof(header)
+                && nirtconfig_isZeroBlock(header) && nirtconfig_finishArchiveRead(&reader) == 0;
+            break;
+        }
+
+        unsigned long long size = strtoull(header + 124, NULL, 8);
+        char type = header[156];
+
+        status = nirtconfig_parseArchiveHeader(header, entryName, sizeof(entryName));
+        if (status != 0)
+            break;
+
+        snprintf(entryPath, sizeof(entryPath), "%s/%s", stagingDir, entryName);
+
+        if (strlen(imageFolder) == 0 && strcmp(entryName, NIRTCONFIG_ARCHIVE_MANIFEST) != 0) //First entry names the image folder
+        {
+            snprintf(imageFolder, bufferSize, "%s/%.*s", stagingDir, (int)strcspn(entryName, "/"), entryName);
+        }
+
+        if (type == '5')
+        {
+            if (mkdir(entryPath, 0755) != 0 && errno != EEXIST)
+                status = 1;
+        }
+        else if (type == '0' || type == '\0')
+            status = nirtconfig_unpackArchiveFile(&reader, entryName, entryPath, size, &manifest, &archivedManifest);
+        else
+        {
+            printf("Unsupported Archive Entry: %s\n", entryName);
+            status = 1;
+        }
+    }
+
+    if (status == 0 && (reader.error || !complete))
+    {
+        printf("Archive Truncated Or Corrupt: %s\n", archivePath);
+        status = 1;
+    }
+    else if (status == 0 && (archivedManifest.empty() || manifest != archivedManifest))
+    {
+        printf("Archive Manifest Mismatch: %s\n", archivePath);
+        status = 1;
+    }
+
+    ZSTD_freeDCtx(reader.dctx);
+    free(reader.inBuffer);
+    free(reader.outBuffer);
+
+    if (reader.in != stdin)
+        fclose(reader.in);
+
+    return status;
+}
+
+int nirtconfig_parseArchiveHeader(const char* header, char* entryName, size_t bufferSize)
+{
+    unsigned int checksum = 0;
+
+    for (int i = 0; i < NIRTCONFIG_ARCHIVE_BLOCK; i++) //Checksum field counts as spaces
+        checksum += (i >= 148 && i < 156) ? ' ' : (unsigned char)header[i];
+
+    if (checksum != strtoul(header + 148, NULL, 8))
+    {
+        printf("Archive Header Checksum Mismatch\n");
+        return 1;
+    }
+
+    if (header[345] != '\0')
+        snprintf(entryName, bufferSize, "%.155s/%.100s", header + 345, header);
+    else
+        snprintf(entryName, bufferSize, "%.100s", header);
+
+    //Refuse entries that would land outside the staging folder
+    if (entryName[0] == '/' || strcmp(entryName, "..") == 0 || strncmp(entryName, "../", 3) == 0
+        || strstr(entryName, "/../") != NULL || (strlen(entryName) >= 3 && strcmp(entryName + strlen(entryName) - 3, "/..") == 0))
+    {
+        printf("Unsafe Archive Entry: %s\n", entryName);
+        return 1;
+    }
+
+    return 0;
+}
+
+int nirtconfig_unpackArchiveFile(struct archiveReader* reader, const char* entryName, const char* entryPath,
+                                 unsigned long long size, std::string* manifest, std::string* archivedManifest)
+{
+    int isManifest = strcmp(entryName, NIRTCONFIG_ARCHIVE_MANIFEST) == 0;
+    FILE* file = isManifest ? NULL : fopen(entryPath, "wb");
+    char chunk[NIRTCONFIG_ARCHIVE_BLOCK * 64];
+    char manifestLine[PATH_MAX + 64] = "";
+    unsigned long long remaining = size;
+    unsigned int crc = 0;
+    int status = 0;
+
+    if (!isManifest && file == NULL)
+    {
+        printf("Unable To Create File: %s\n", entryPath);
+        return 1;
+    }
+
+    while (status == 0 && remaining > 0) //Copy file contents, checksumming as they pass
+    {
+        size_t length = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+
+        if (nirtconfig_archiveRead(reader, chunk, length) != length)
+        {
+            printf("Archive Truncated Or Corrupt At: %s\n", entryName);
+            status = 1;
+        }
+        else if (isManifest)
+            archivedManifest->append(chunk, length);
+        else
+        {
+            crc = nirtconfig_crc32(crc, chunk, length);
+            if (fwrite(chunk, 1, length, file) != length)
+                status = 1;
+        }
+
+        remaining -= length;
+    }
+
+    size_t padding = (NIRTCONFIG_ARCHIVE_BLOCK - size % NIRTCONFIG_ARCHIVE_BLOCK) % NIRTCONFIG_ARCHIVE_BLOCK;
+    if (status == 0 && padding > 0 && nirtconfig_archiveRead(reader, chunk, padding) != padding)
+        status = 1;
+
+    if (!isManifest)
+    {
+        snprintf(manifestLine, sizeof(manifestLine), "%08x %llu %s\n", crc, size, entryName);
+        manifest->append(manifestLine);
+
+        if (fclose(file) != 0)
+            status = 1;
+    }
+
+    return status;
+}
+
+size_t nirtconfig_archiveRead(struct archiveReader* reader, void* data, size_t length)
+{
+    size_t copied = 0;
+
+    while (copied < length)
+    {
+        if (reader->outPos == reader->outFill) //Decompressed buffer drained, decode more
+        {
+            //Only read more input once the decoder has flushed everything it holds
+            if (reader->input.pos == reader->input.size && !reader->outputFull)
+            {
+                reader->input.size = fread(reader->inBuffer, 1, reader->inSize, reader->in);
+                reader->input.pos = 0;
+
+                if (reader->input.size == 0)
+                    return copied;
+            }
+
+            ZSTD_outBuffer output = { reader->outBuffer, reader->outSize, 0 };
+            size_t result = ZSTD_decompressStream(reader->dctx, &output, &reader->input);
+
+            if (ZSTD_isError(result))
+            {
+                reader->error = 1;
+                return copied;
+            }
+
+            reader->frameRemaining = result;
+            reader->outPos = 0;
+            reader->outFill = output.pos;
+            reader->outputFull = output.pos == output.size;
+            continue;
+        }
+
+        size_t available = reader->outFill - reader->outPos;
+        size_t chunk = length - copied < available ? length - copied : available;
+
+        memcpy((char*)data + copied, reader->outBuffer + reader->outPos, chunk);
+        reader->outPos += chunk;
+        copied += chunk;
+    }
+
+    return copied;
+}
+
+int nirtconfig_isZeroBlock(const char* block)
+{
+    for (int i = 0; i < NIRTCONFIG_ARCHIVE_BLOCK; i++)
+    {
+        if (block[i] != '\0')
+            return 0;
+    }
+
+    return 1;
+}
+
+int nirtconfig_finishArchiveRead(struct archiveReader* reader)
+{
+    char trailer[NIRTCONFIG_ARCHIVE_BLOCK];
+    size_t length;
+
+    //Drain to the end of input so zstd reaches the frame end and verifies its checksum
+    while ((length = nirtconfig_archiveRead(reader, trailer, sizeof(trailer))) > 0)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            if (trailer[i] != '\0')
+                return 1; //Data after the end-of-archive marker
+        }
+    }
+
+    return reader->error || reader->frameRemaining != 0;
+}
+
+static unsigned int crc32Table[256];
+static pthread_once_t crc32TableInit = PTHREAD_ONCE_INIT;
+
+void nirtconfig_buildCrc32Table()
+{
+    for (unsigned int i = 0; i < 256; i++) //Reflected CRC-32 polynomial, same as zlib and gzip
+    {
+        unsigned int value = i;
+
+        for (int bit = 0; bit < 8; bit++)
+            value = (value & 1) ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+
+        crc32Table[i] = value;
+    }
+}
+
+unsigned int nirtconfig_crc32(unsigned int crc, const void* data, size_t length)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+
+    pthread_once(&crc32TableInit, nirtconfig_buildCrc32Table);
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++)
+        crc = crc32Table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+
+    return ~crc;
+}
@@ -1,5 +1,16 @@
+#include <string>
+#include <ftw.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <zstd.h>
 #include <nisyscfg/nisyscfg.h>
 
+#define NIRTCONFIG_ARCHIVE_EXTENSION ".tar.zst"
+#define NIRTCONFIG_ARCHIVE_MANIFEST  "MANIFEST.crc32"
+#define NIRTCONFIG_ARCHIVE_BLOCK     512
+#define NIRTCONFIG_MAX_SLOTS         64
+#define NIRTCONFIG_HANDLE_KINDS      4
+
 struct hwNode //Node for creating linked list of hardware modules
 {
     int slot;
@@ -8,6 +19,84 @@ struct hwNode //Node for creating linked list of hardware modules
     struct hwNode *next;
 };
 
+enum handleKind
+{
+    HANDLE_SESSION,
+    HANDLE_RESOURCE,
+    HANDLE_FILTER,
+    HANDLE_ENUMERATION
+};
+
+struct handleRecord //Node for list of open NISysCfg handles
+{
+    void *handle;
+    enum handleKind kind;
+    struct handleRecord *next;
+};
+
+struct handleStats //Open/close counters for one kind of handle
+{
+    int opened;
+    int closed;
+    int live;
+    int peak;
+};
+
+enum transferState
+{
+    TRANSFER_PENDING,
+    TRANSFER_RUNNING,
+    TRANSFER_DONE
+};
+
+struct transferJob //Image or firmware transfer queued by the scheduler
+{
+    char command[16];
+    char target[NISYSCFG_SIMPLE_STRING_LENGTH];
+    char path[NISYSCFG_SIMPLE_STRING_LENGTH];
+    char username[NISYSCFG_SIMPLE_STRING_LENGTH];
+    char password[NISYSCFG_SIMPLE_STRING_LENGTH];
+    char subnet[NISYSCFG_SIMPLE_STRING_LENGTH];
+    double bytes;
+    double seconds;
+    int isArchive;
+    enum transferState state;
+    int status;
+};
+
+struct transferScheduler //Shared state between transfer worker threads
+{
+    struct transferJob *jobs;
+    int jobCount;
+    int subnetLimit;
+    pthread_mutex_t lock;
+    pthread_cond_t jobFinished;
+};
+
+struct archiveWriter //Streams tar entries through a zstd compressor
+{
+    FILE *out;
+    ZSTD_CCtx *cctx;
+    char *outBuffer;
+    size_t outSize;
+};
+
+struct archiveReader //Streams tar entries out of a zstd decompressor
+{
+    FILE *in;
+    ZSTD_DCtx *dctx;
+    char *inBuffer;
+    size_t inSize;
+    ZSTD_inBuffer input;
+    char *outBuffer;
+    size_t outSize;
+    size_t outPos;
+    size_t outFill;
+    size_t frameRemaining;
+    int outputFull;
+    int error;
+};
+
 
 //Callable Functions
 //Must be in the following form:
@@ -25,15 +114,74 @@ int nirtconfig_setModuleMode(int argc, char** argv);
 int nirtconfig_listHardware(int argc, char** argv);
 int nirtconfig_format(int argc, char** argv);
 int nirtconfig_setAlias(int argc, char** argv);
+int nirtconfig_scheduleTransfers(int argc, char** argv);
+
+//Handle tracking
+//Every NISysCfg handle is opened and closed through these so leaks show up in --stats
+void nirtconfig_trackHandle(void* handle, enum handleKind kind);
+NISysCfgStatus nirtconfig_closeHandle(void* handle);
+NISysCfgStatus nirtconfig_initializeSession(const char* targetName, const char* username, const char* password,
+                                            NISysCfgLocale language, NISysCfgBool forcePropertyRefresh, unsigned int connectTimeoutMsec,
+                                            NISysCfgEnumExpertHandle* expertEnumHandle, NISysCfgSessionHandle* sessionHandle);
+NISysCfgStatus nirtconfig_findSystems(NISysCfgSessionHandle session, const char* deviceClass, NISysCfgBool detectOnlineSystems,
+                                      NISysCfgIncludeCachedResults cachePreference, NISysCfgSystemNameFormat systemNameFormat,
+                                      int timeoutMsec, NISysCfgBool onlyInstallableSystems, NISysCfgEnumSystemHandle* systemEnumHandle);
+NISysCfgStatus nirtconfig_createFilter(NISysCfgSessionHandle session, NISysCfgFilterHandle* filter);
+NISysCfgStatus nirtconfig_findHardware(NISysCfgSessionHandle session, NISysCfgFilterMode filterMode, NISysCfgFilterHandle filter,
+                                       const char* expertNames, NISysCfgEnumResourceHandle* resourceEnumHandle);
+NISysCfgStatus nirtconfig_nextResource(NISysCfgSessionHandle session, NISysCfgEnumResourceHandle resourceEnumHandle,
+                                       NISysCfgResourceHandle* resource);
+NISysCfgStatus nirtconfig_renameResource(NISysCfgResourceHandle resource, const char* newName, NISysCfgBool overwriteIfExists,
+                                         NISysCfgBool updateDependencies, NISysCfgBool* nameAlreadyExisted,
+                                         NISysCfgResourceHandle* overwrittenResource);
+void nirtconfig_printHandleStats();
+int nirtconfig_printLeakedHandles();
 
 //Subroutines
 void nirtconfig_printStatusInfo(int status);
+int nirtconfig_getGlobalOptions(int argc, char** argv);
 int nirtconfig_findSingleTarget(char *targetName);
 int nirtconfig_findAllTargets();
 void nirtconfig_printSystemInfo(NISysCfgSessionHandle session);
-void nirtconfig_buildOutputDir(NISysCfgSessionHandle session, char* pathBuffer);
+void nirtconfig_buildOutputDir(NISysCfgSessionHandle session, const char* parentDir, char* pathBuffer, size_t bufferSize);
+int nirtconfig_getTargetImage(char* targetName, char* username, char* password, char* destination, size_t destinationSize, char* archivePath);
+int nirtconfig_setTargetImage(char* targetName, char* username, char* password, char* imagePath);
+int nirtconfig_updateTargetFirmware(char* targetName, char* firmwarePath, char* username, char* password);
 void nirtconfig_printSelfTestResults(NISysCfgResourceHandle resource);
 void nirtconfig_getCredentials(int argc, char** argv, char* username, char* password);
 int nirtconfig_findFirmwareResource(NISysCfgSessionHandle session, NISysCfgResourceHandle *resource);
 void nirtconfig_setAllModuleModes(NISysCfgSessionHandle session, NISysCfgModuleProgramMode moduleMode);
-void nirtconfig_printHardwareList(NISysCfgResourceHandle resource);
\ No newline at end of file
+void nirtconfig_printHardwareList(NISysCfgResourceHandle resource);
+int nirtconfig_setAliasMap(char* targetName, char* mapFile);
+int nirtconfig_readAliasMap(char* mapFile, struct hwNode** aliasMap);
+void nirtconfig_freeHardwareList(struct hwNode* list);
+int nirtconfig_getScheduleOptions(int argc, char** argv, double* aggregateMbps, double* transferMbps, int* subnetLimit);
+int nirtconfig_readTransferJobs(char* jobFile, struct transferScheduler* scheduler);
+void nirtconfig_planTransferJob(struct transferJob* job);
+void nirtconfig_buildSubnet(char* targetName, char* ipAddr, char* subnetMask, char* subnet);
+double nirtconfig_getPathSize(const char* path);
+int nirtconfig_compareTransferJobs(const void* a, const void* b);
+void* nirtconfig_transferWorker(void* arg);
+struct transferJob* nirtconfig_nextTransferJob(struct transferScheduler* scheduler);
+int nirtconfig_transfersPending(struct transferScheduler* scheduler);
+void nirtconfig_runTransferJob(struct transferJob* job);
+double nirtconfig_elapsedSeconds(struct timespec* start, struct timespec* end);
+void nirtconfig_printTransferReport(struct transferScheduler* scheduler, double makespan);
+int nirtconfig_isImageArchive(const char* path);
+int nirtconfig_createStagingDir(char* stagingDir, size_t bufferSize);
+int nirtconfig_removeStagingEntry(const char* path, const struct stat* info, int flag, struct FTW* ftwBuffer);
+void nirtconfig_removeStagingDir(const char* stagingDir);
+int nirtconfig_packImageArchive(const char* imageFolder, const char* archivePath);
+int nirtconfig_packArchiveEntry(struct archiveWriter* writer, const char* path, const char* entryName, std::string* manifest);
+int nirtconfig_writeArchiveFile(struct archiveWriter* writer, const char* entryName, const char* data, size_t length);
+int nirtconfig_writeArchiveHeader(struct archiveWriter* writer, const char* entryName, unsigned long long size, char type, const struct stat* info);
+int nirtconfig_archiveWrite(struct archiveWriter* writer, const void* data, size_t length, ZSTD_EndDirective mode);
+int nirtconfig_unpackImageArchive(const char* archivePath, const char* stagingDir, char* imageFolder, size_t bufferSize);
+int nirtconfig_parseArchiveHeader(const char* header, char* entryName, size_t bufferSize);
+int nirtconfig_unpackArchiveFile(struct archiveReader* reader, const char* entryName, const char* entryPath,
+                                 unsigned long long size, std::string* manifest, std::string* archivedManifest);
+size_t nirtconfig_archiveRead(struct archiveReader* reader, void* data, size_t length);
+int nirtconfig_isZeroBlock(const char* block);
+int nirtconfig_finishArchiveRead(struct archiveReader* reader);
+void nirtconfig_buildCrc32Table();
+unsigned int nirtconfig_crc32(unsigned int crc, const void* data, size_t length);
\ No newline at end of file